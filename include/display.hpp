@@ -4,6 +4,18 @@
 #include <sstream>
 
 struct Display {
+    enum ParticleColor {
+        GREEN,
+        BROWN,
+        MAGENTA,
+        BLUE,
+        YELLOW,
+        PARTICLE_COLOR_COUNT,
+    };
+
+    static constexpr const char* PARTICLE_COLORS[PARTICLE_COLOR_COUNT] = {
+            "green", "brown", "magenta", "blue", "yellow"};
+
     struct Config {
         size_t svg_width = 1000;
         size_t svg_height = 1000;
@@ -20,5 +32,8 @@ struct Display {
     void drawNodeSvg(std::stringstream& ss, const vsm::NodeInfoT& node, float scale = 0.5f,
             const std::vector<float>* from = nullptr) const;
     void writeSvgStartTag(std::stringstream& ss, float x, float y, float r) const;
-    static const char* assignParticleColor(const Particles::Particle& particle);
+    static ParticleColor classifyParticle(const Particles::Particle& particle);
+    static const char* assignParticleColor(const Particles::Particle& particle) {
+        return PARTICLE_COLORS[classifyParticle(particle)];
+    }
 };
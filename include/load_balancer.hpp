@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LoadBalancer {
+public:
+    enum ErrorType {
+        RADIUS_ADJUSTED = 100,
+    };
+
+    struct Config {
+        float min_radius = 12.5f;
+        float max_radius = 50;
+        float radius_gain = 0.05f;
+        float cost_smoothing = 0.1f;
+    };
+
+    // advertised to peers, format tags the wire layout
+    struct Load {
+        static constexpr uint32_t FORMAT = 1;
+        uint32_t format = FORMAT;
+        float tick_cost = 0;
+        float radius = 0;
+    };
+
+    // reported to logger after each adjustment
+    struct Status {
+        float tick_cost;
+        float peer_tick_cost;
+        float radius;
+    };
+
+    using PeerLoads = std::unordered_map<std::string, Load>;
+
+    LoadBalancer(Config config);
+
+    void recordTickCost(float tick_cost);
+    void setPeerLoads(PeerLoads peer_loads);
+    bool getPeerLoad(const std::string& address, Load& load) const;
+    Status balanceRadius(float& radius, const std::vector<std::string>& peer_addresses) const;
+
+    // accessors
+    const Config& getConfig() const { return _config; }
+    float getTickCost() const;
+
+private:
+    Config _config;
+    mutable std::mutex _mutex;
+    float _tick_cost = 0;
+    PeerLoads _peer_loads;
+};
@@ -23,6 +23,14 @@ public:
 
     using ParticleLookup = std::unordered_map<uint32_t, Particle>;
 
+    // durations of each phase in the last update (ms)
+    struct PhaseDurations {
+        float respawn = 0;
+        float prune = 0;
+        float rebuild = 0;
+        float simulate = 0;
+    };
+
     struct Config {
         Point simulation_origin = {0, 0};
         float simulation_radius = 25;
@@ -49,6 +57,8 @@ public:
     const RTree& getRTree() const { return _rtree; }
     RTree& getRTree() { return _rtree; }
 
+    const PhaseDurations& getPhaseDurations() const { return _phase_durations; }
+
 private:
     void respawnParticles();
     void pruneParticles();
@@ -63,4 +73,5 @@ private:
     RTree _rtree;
     std::vector<PointValue> _insert_buffer;
     ParticleLookup _particles;
+    PhaseDurations _phase_durations;
 };
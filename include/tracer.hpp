@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define TRACE_SCOPE_CONCAT_(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Tracer::Scope TRACE_SCOPE_CONCAT(_trace_scope_, __LINE__)(name)
+
+// Records scoped begin/end events into per-thread ring buffers and writes them as Chrome trace
+// JSON. Each buffer has a single writer (its owning thread), so recording takes no locks.
+class Tracer {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+    // oldest slots skipped on dump since writers may be overwriting them
+    static constexpr size_t BUFFER_GUARD = 1 << 10;
+
+    struct Event {
+        const char* name;
+        int64_t timestamp;  // microseconds
+        char phase;
+    };
+
+    class Scope {
+    public:
+        Scope(const char* name)
+                : _name(Tracer::isEnabled() ? name : nullptr) {
+            if (_name) {
+                Tracer::record(_name, 'B');
+            }
+        }
+        ~Scope() {
+            if (_name) {
+                Tracer::record(_name, 'E');
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* _name;
+    };
+
+    static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+    static void setThreadName(const char* name);
+    static void start();
+    static void stop();
+    static void record(const char* name, char phase);
+    static void writeJson(std::ostream& os);
+
+private:
+    struct Buffer {
+        std::atomic<uint64_t> head{0};
+        // announced before a slot is written, lets dumps detect overwritten slots
+        std::atomic<uint64_t> claimed{0};
+        uint64_t tail = 0;
+        uint32_t thread_id;
+        std::string thread_name;
+        std::array<Event, BUFFER_SIZE> events;
+    };
+
+    static Buffer& getThreadBuffer();
+    static int64_t now();
+
+    static std::atomic<bool> _enabled;
+    static std::atomic<int64_t> _stop_timestamp;
+    static std::mutex _buffers_mutex;
+    static std::vector<std::unique_ptr<Buffer>> _buffers;
+    static const std::chrono::steady_clock::time_point _epoch;
+};
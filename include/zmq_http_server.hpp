@@ -23,6 +23,8 @@ public:
         return _timers.add(interval, std::move(timer_handler));
     }
 
+    void removeTimer(int timer_id) { _timers.cancel(timer_id); }
+
     void poll(int timeout = -1);
 
 private:
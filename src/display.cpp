@@ -1,5 +1,7 @@
 #include <display.hpp>
 
+constexpr const char* Display::PARTICLE_COLORS[];
+
 void Display::writeSvgStartTag(std::stringstream& ss, float x, float y, float r) const {
     ss << "<svg xmlns=\"http://www.w3.org/2000/svg\" ";
     ss << "xmlns:xlink=\"http://www.w3.org/1999/xlink\" ";
@@ -93,17 +95,17 @@ void Display::drawNodeSvg(std::stringstream& ss, const vsm::NodeInfoT& node, flo
     ss << "</a>\r\n";
 }
 
-const char* Display::assignParticleColor(const Particles::Particle& particle) {
+Display::ParticleColor Display::classifyParticle(const Particles::Particle& particle) {
     size_t total_neighbors = particle.left_neighbors + particle.right_neighbors;
     if (total_neighbors > 35) {
-        return "yellow";
+        return YELLOW;
     } else if (total_neighbors > 16) {
-        return "blue";
+        return BLUE;
     } else if (particle.close_neighbors > 15) {
-        return "magenta";
+        return MAGENTA;
     } else if (total_neighbors > 13) {
-        return "brown";
+        return BROWN;
     } else {
-        return "green";
+        return GREEN;
     }
 }
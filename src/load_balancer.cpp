@@ -0,0 +1,70 @@
+#include <load_balancer.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+LoadBalancer::LoadBalancer(Config config)
+        : _config(std::move(config)) {
+    if (_config.min_radius <= 0) {
+        throw std::invalid_argument("positive min radius required");
+    }
+    if (_config.max_radius < _config.min_radius) {
+        throw std::invalid_argument("radius max >= min required");
+    }
+    if (_config.cost_smoothing <= 0 || _config.cost_smoothing > 1) {
+        throw std::invalid_argument("cost smoothing in (0, 1] required");
+    }
+}
+
+void LoadBalancer::recordTickCost(float tick_cost) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tick_cost += _config.cost_smoothing * (tick_cost - _tick_cost);
+}
+
+void LoadBalancer::setPeerLoads(PeerLoads peer_loads) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _peer_loads = std::move(peer_loads);
+}
+
+bool LoadBalancer::getPeerLoad(const std::string& address, Load& load) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto peer_load = _peer_loads.find(address);
+    if (peer_load == _peer_loads.end()) {
+        return false;
+    }
+    load = peer_load->second;
+    return true;
+}
+
+float LoadBalancer::getTickCost() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tick_cost;
+}
+
+LoadBalancer::Status LoadBalancer::balanceRadius(
+        float& radius, const std::vector<std::string>& peer_addresses) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // average tick cost of peers with a known load
+    float peer_tick_cost = 0;
+    size_t peer_count = 0;
+    for (const auto& address : peer_addresses) {
+        auto peer_load = _peer_loads.find(address);
+        if (peer_load != _peer_loads.end()) {
+            peer_tick_cost += peer_load->second.tick_cost;
+            ++peer_count;
+        }
+    }
+    // shrink when hotter than neighbors, grow when colder
+    if (peer_count > 0) {
+        peer_tick_cost /= peer_count;
+        float max_tick_cost = std::max(_tick_cost, peer_tick_cost);
+        if (max_tick_cost > 0) {
+            float cost_error = (peer_tick_cost - _tick_cost) / max_tick_cost;
+            radius *= 1 + _config.radius_gain * cost_error;
+        }
+    } else {
+        peer_tick_cost = _tick_cost;
+    }
+    radius = std::min(std::max(radius, _config.min_radius), _config.max_radius);
+    return {_tick_cost, peer_tick_cost, radius};
+}
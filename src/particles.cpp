@@ -1,13 +1,22 @@
 #include <particles.hpp>
+#include <tracer.hpp>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/arithmetic/cross_product.hpp>
 #include <boost/geometry/strategies/transform/matrix_transformers.hpp>
 
+#include <chrono>
 #include <stdexcept>
 
 namespace bg = boost::geometry;
 
+static float elapsedMs(std::chrono::steady_clock::time_point& start) {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<float, std::milli> elapsed = now - start;
+    start = now;
+    return elapsed.count();
+}
+
 Particles::Particles(Config config)
         : _config(std::move(config))
         , _random_generator(_random_device())
@@ -27,18 +36,36 @@ Particles::Particles(Config config)
 }
 
 void Particles::update() {
+    TRACE_SCOPE("Particles::update");
+    auto phase_start = std::chrono::steady_clock::now();
     // setup particles
-    respawnParticles();
-    pruneParticles();
-    rebuildRTree();
+    {
+        TRACE_SCOPE("Particles::respawnParticles");
+        respawnParticles();
+    }
+    _phase_durations.respawn = elapsedMs(phase_start);
+    {
+        TRACE_SCOPE("Particles::pruneParticles");
+        pruneParticles();
+    }
+    _phase_durations.prune = elapsedMs(phase_start);
+    {
+        TRACE_SCOPE("Particles::rebuildRTree");
+        rebuildRTree();
+    }
+    _phase_durations.rebuild = elapsedMs(phase_start);
     // simulate each particle
-    for (auto& particle : _particles) {
-        // update velocity
-        updateParticleNeighborCount(particle.second);
-        updateParticleVelocity(particle.second);
-        // update position
-        bg::add_point(particle.second.position, particle.second.velocity);
+    {
+        TRACE_SCOPE("Particles::simulate");
+        for (auto& particle : _particles) {
+            // update velocity
+            updateParticleNeighborCount(particle.second);
+            updateParticleVelocity(particle.second);
+            // update position
+            bg::add_point(particle.second.position, particle.second.velocity);
+        }
     }
+    _phase_durations.simulate = elapsedMs(phase_start);
 }
 
 void Particles::spawnParticle(const Point& position) {
@@ -52,6 +79,11 @@ void Particles::spawnParticle(const Point& position) {
 void Particles::respawnParticles() {
     float r2 = _config.simulation_radius * _config.simulation_radius;
     float min_particles = 4 * r2 * _config.simulation_min_density;
+    // simulation radius may be resized at runtime
+    if (_uniform_distribution.b() != _config.simulation_radius) {
+        _uniform_distribution.param(decltype(_uniform_distribution)::param_type(
+                -_config.simulation_radius, _config.simulation_radius));
+    }
     while (_particles.size() < min_particles) {
         Point position(
                 _uniform_distribution(_random_generator), _uniform_distribution(_random_generator));
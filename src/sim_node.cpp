@@ -1,5 +1,7 @@
 #include <display.hpp>
+#include <load_balancer.hpp>
 #include <particles.hpp>
+#include <tracer.hpp>
 #include <zmq_http_server.hpp>
 #include <vsm/zmq_transport.hpp>
 
@@ -8,8 +10,14 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/program_options.hpp>
 
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <thread>
 
 static constexpr char INDEX_RESPONSE[] =
@@ -25,7 +33,17 @@ static constexpr char SVG_RESPONSE_HEADER[] =
         "Content-Encoding: gzip\r\n"
         "\r\n";
 
+static constexpr char JSON_RESPONSE_HEADER[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Disposition: attachment; filename=\"trace.json\"\r\n"
+        "Content-Encoding: gzip\r\n"
+        "\r\n";
+
+static constexpr char LOAD_ENTITY_PREFIX[] = "load:";
+
 static std::stringstream compress(std::stringstream& in) {
+    TRACE_SCOPE("compress");
     namespace bio = boost::iostreams;
     std::stringstream ss;
     bio::filtering_streambuf<bio::input> out;
@@ -35,6 +53,65 @@ static std::stringstream compress(std::stringstream& in) {
     return ss;
 }
 
+static void fastForward(Particles& particles, uint32_t ticks, std::ostream* stats_stream) {
+    if (stats_stream) {
+        *stats_stream << "tick,particles";
+        for (const char* color : Display::PARTICLE_COLORS) {
+            *stats_stream << "," << color;
+        }
+        *stats_stream << std::endl;
+    }
+    Particles::PhaseDurations total;
+    // only time spent in update counts, stats output is excluded
+    std::chrono::duration<float> elapsed(0);
+    for (uint32_t tick = 0; tick < ticks; ++tick) {
+        auto start = std::chrono::steady_clock::now();
+        particles.update();
+        elapsed += std::chrono::steady_clock::now() - start;
+        const auto& phase = particles.getPhaseDurations();
+        total.respawn += phase.respawn;
+        total.prune += phase.prune;
+        total.rebuild += phase.rebuild;
+        total.simulate += phase.simulate;
+        if (!stats_stream) {
+            continue;
+        }
+        // count particles in each color class
+        size_t color_counts[Display::PARTICLE_COLOR_COUNT] = {};
+        for (const auto& particle : particles.getParticles()) {
+            ++color_counts[Display::classifyParticle(particle.second)];
+        }
+        *stats_stream << tick << "," << particles.getParticles().size();
+        for (size_t count : color_counts) {
+            *stats_stream << "," << count;
+        }
+        *stats_stream << "\n";
+    }
+    if (ticks == 0 || elapsed.count() <= 0) {
+        return;
+    }
+    // format locally to leave std::cout precision untouched for the logger
+    std::ostringstream summary;
+    summary << "fast forwarded " << ticks << " ticks in " << elapsed.count() << " s  ("
+            << ticks / elapsed.count() << " ticks/s)" << std::endl;
+    summary << std::fixed << std::setprecision(3) << "mean phase ms  respawn "
+            << total.respawn / ticks << "  prune " << total.prune / ticks << "  rebuild "
+            << total.rebuild / ticks << "  simulate " << total.simulate / ticks << std::endl;
+    std::cout << summary.str();
+}
+
+static bool writeTrace(const std::string& trace_file) {
+    Tracer::stop();
+    std::ofstream trace_stream(trace_file);
+    if (!trace_stream.is_open()) {
+        std::cout << "failed to open trace file " << trace_file << std::endl;
+        return false;
+    }
+    Tracer::writeJson(trace_stream);
+    std::cout << "trace written to " << trace_file << std::endl;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // parse arguments
     namespace po = boost::program_options;
@@ -44,19 +121,27 @@ int main(int argc, char* argv[]) {
         // clang-format off
         desc.add_options()
         ("name,n", po::value<std::string>()->default_value("node"), "mesh node name")
-        ("address,a", po::value<std::string>()->required(), "mesh node external address")
+        ("address,a", po::value<std::string>(), "mesh node external address")
         ("name-as-link,l", po::bool_switch()->default_value(false), "use name as http link")
         ("bootstrap-peer,b", po::value<std::vector<std::string>>(), "mesh bootstrap peer (address:port)")
         ("x-coord,x", po::value<float>()->default_value(0), "mesh node x coordinate")
         ("y-coord,y", po::value<float>()->default_value(0), "mesh node y coordinate")
         ("distance-gain,g", po::value<float>()->default_value(0.002f), "distance control gain")
         ("sim-radius,r", po::value<float>()->default_value(25), "simulation region radius")
+        ("min-radius", po::value<float>(), "min simulation region radius (default sim-radius / 2)")
+        ("max-radius", po::value<float>(), "max simulation region radius (default sim-radius * 2)")
+        ("radius-gain", po::value<float>()->default_value(0.05f), "load balancing radius gain")
         ("sim-density,d", po::value<float>()->default_value(0.08f), "simulation particle density")
         ("mesh-port,P", po::value<uint32_t>()->default_value(11511), "mesh node UDP port")
         ("http-port,p", po::value<uint32_t>()->default_value(8000), "http server TCP port")
         ("sim-interval,i", po::value<uint32_t>()->default_value(20), "sim update interval (ms)")
         ("mesh-interval,I", po::value<uint32_t>()->default_value(500), "mesh update interval (ms)")
         ("message-size,m", po::value<uint32_t>()->default_value(7000), "transmission message size")
+        ("fast-forward,f", po::value<uint32_t>()->default_value(0), "sim ticks to run at startup")
+        ("headless,H", po::bool_switch()->default_value(false), "exit after fast forward")
+        ("stats-file,s", po::value<std::string>(), "write per tick fast forward stats csv to file")
+        ("trace-file,t", po::value<std::string>(), "write chrome trace of startup to file")
+        ("trace-duration,T", po::value<uint32_t>()->default_value(10000), "trace duration (ms)")
         ("verbosity,v", po::value<uint32_t>()->default_value(vsm::Logger::INFO), "verbosity filter 0-6")
         ("help,h", "produce help message");
         // clang-format on
@@ -70,6 +155,13 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         po::notify(args);
+        if (!args["headless"].as<bool>() && !args.count("address")) {
+            throw po::required_option("address");
+        }
+        if ((args["headless"].as<bool>() || args.count("stats-file")) &&
+                !args["fast-forward"].as<uint32_t>()) {
+            throw po::required_option("fast-forward");
+        }
     } catch (const po::error& e) {
         std::cout << e.what() << std::endl;
         return -1;
@@ -82,10 +174,59 @@ int main(int argc, char* argv[]) {
     sim_config.simulation_min_density = args["sim-density"].as<float>();
     sim_config.simulation_max_density = 2 * sim_config.simulation_min_density;
     float distance_gain = args["distance-gain"].as<float>();
+    LoadBalancer::Config load_config;
+    load_config.min_radius = args.count("min-radius") ? args["min-radius"].as<float>()
+                                                      : sim_config.simulation_radius / 2;
+    load_config.max_radius = args.count("max-radius") ? args["max-radius"].as<float>()
+                                                      : sim_config.simulation_radius * 2;
+    load_config.radius_gain = args["radius-gain"].as<float>();
+    if (load_config.min_radius <= 0) {
+        std::cout << "min-radius must be positive" << std::endl;
+        return -1;
+    }
+    if (load_config.radius_gain < 0) {
+        std::cout << "radius-gain must not be negative" << std::endl;
+        return -1;
+    }
+    if (sim_config.simulation_radius < load_config.min_radius ||
+            sim_config.simulation_radius > load_config.max_radius) {
+        std::cout << "sim-radius must be within [min-radius, max-radius]" << std::endl;
+        return -1;
+    }
     auto http_port = std::to_string(args["http-port"].as<uint32_t>());
     auto mesh_port = std::to_string(args["mesh-port"].as<uint32_t>());
     uint32_t mesh_interval = args["mesh-interval"].as<uint32_t>();
     uint32_t sim_interval = args["sim-interval"].as<uint32_t>();
+
+    // startup trace capture also covers the fast forward
+    if (args.count("trace-file")) {
+        Tracer::setThreadName("main");
+        Tracer::start();
+    }
+
+    // warm up particle sim as fast as possible before networking starts
+    Particles particles(sim_config);
+    if (args["fast-forward"].as<uint32_t>()) {
+        std::ofstream stats_file;
+        if (args.count("stats-file")) {
+            stats_file.open(args["stats-file"].as<std::string>());
+            if (!stats_file.is_open()) {
+                std::cout << "failed to open stats file " << args["stats-file"].as<std::string>()
+                          << std::endl;
+                return -1;
+            }
+        }
+        fastForward(particles, args["fast-forward"].as<uint32_t>(),
+                stats_file.is_open() ? &stats_file : nullptr);
+    }
+    if (args["headless"].as<bool>()) {
+        if (args.count("trace-file") && !writeTrace(args["trace-file"].as<std::string>())) {
+            return -1;
+        }
+        return 0;
+    }
+
+    auto mesh_address = "udp://" + args["address"].as<std::string>() + ":" + mesh_port;
     vsm::MeshNode::Config mesh_config{
             mesh_interval,                        // peer update interval
             sim_interval * 30,                    // entity expiry interval
@@ -94,7 +235,7 @@ int main(int argc, char* argv[]) {
             {},                                   // ego sphere
             {
                     args["name"].as<std::string>(),                                  // name
-                    "udp://" + args["address"].as<std::string>() + ":" + mesh_port,  // address
+                    mesh_address,                                                    // address
                     {sim_config.simulation_origin.x(),
                             sim_config.simulation_origin.y()},  // coordinates
                     0xFFFFFFFF,                                 // group mask
@@ -140,6 +281,14 @@ int main(int argc, char* argv[]) {
                     case vsm::MeshNode::MESSAGE_VERIFY_FAIL:
                         std::cout << "  dropped buffer size " << len;
                         break;
+                    case LoadBalancer::RADIUS_ADJUSTED:
+                        if (data) {
+                            auto status = (const LoadBalancer::Status*) data;
+                            std::cout << "  tick cost " << status->tick_cost;
+                            std::cout << "  peer tick cost " << status->peer_tick_cost;
+                            std::cout << "  radius " << status->radius;
+                        }
+                        break;
                     default:
                         break;
                 }
@@ -147,7 +296,7 @@ int main(int argc, char* argv[]) {
             });
 
     // create objects from config
-    Particles particles(sim_config);
+    LoadBalancer load_balancer(load_config);
     vsm::MeshNode mesh_node(mesh_config);
     ZmqHttpServer http_server(http_port.c_str());
     Display display;
@@ -162,15 +311,35 @@ int main(int argc, char* argv[]) {
     }
 
     // define entity to particle conversion
-    const auto parse_particles = [&particles, &mesh_node]() {
+    const auto parse_particles = [&particles, &load_balancer, &mesh_node]() {
         auto entities = mesh_node.getEntities();
+        LoadBalancer::PeerLoads peer_loads;
         for (const auto& update : entities.first) {
+            // peer load advertisements are not particles
+            if (!update.first.compare(0, sizeof(LOAD_ENTITY_PREFIX) - 1, LOAD_ENTITY_PREFIX)) {
+                LoadBalancer::Load load;
+                const auto& data = update.second.entity.data;
+                if (data.size() == sizeof(load)) {
+                    std::memcpy(&load, data.data(), sizeof(load));
+                    if (load.format == LoadBalancer::Load::FORMAT) {
+                        peer_loads[update.first.substr(sizeof(LOAD_ENTITY_PREFIX) - 1)] = load;
+                    }
+                }
+                continue;
+            }
+            // skip entities that are not particles instead of throwing
             const auto& coords = update.second.entity.coordinates;
-            uint32_t id = static_cast<uint32_t>(std::stoul(update.first));
-            auto& particle = particles.getParticles()[id] = {{coords[0], coords[1]}, {}, id};
             const auto& data = update.second.entity.data;
+            char* id_end;
+            uint32_t id = static_cast<uint32_t>(std::strtoul(update.first.c_str(), &id_end, 10));
+            if (update.first.empty() || *id_end || coords.size() != 2 ||
+                    data.size() != sizeof(Particles::Point)) {
+                continue;
+            }
+            auto& particle = particles.getParticles()[id] = {{coords[0], coords[1]}, {}, id};
             std::memcpy(&particle.velocity, data.data(), data.size());
         }
+        load_balancer.setPeerLoads(std::move(peer_loads));
     };
 
     // define particle to entity conversion
@@ -182,18 +351,51 @@ int main(int argc, char* argv[]) {
             entity.name = std::to_string(particle.first);
             entity.coordinates = {particle.second.position.x(), particle.second.position.y()};
             entity.filter = vsm::Filter::NEAREST;
-            entity.range = sim_config.simulation_radius;
+            entity.range = particles.getConfig().simulation_radius;
             entity.data.resize(sizeof(Particles::Point));
             entity.expiry = sim_interval * 5 * 1000 * 1000;
             std::memcpy(entity.data.data(), &particle.second.velocity, sizeof(Particles::Point));
             entities.emplace_back(std::move(entity));
         }
+        // advertise tick cost and radius to neighboring nodes
+        LoadBalancer::Load load;
+        load.tick_cost = load_balancer.getTickCost();
+        load.radius = particles.getConfig().simulation_radius;
+        vsm::EntityT entity;
+        entity.name = LOAD_ENTITY_PREFIX + mesh_address;
+        entity.coordinates = {particles.getConfig().simulation_origin.x(),
+                particles.getConfig().simulation_origin.y()};
+        entity.filter = vsm::Filter::ALL;
+        entity.range = 4 * load_config.max_radius;
+        entity.data.resize(sizeof(load));
+        entity.expiry = mesh_interval * 4 * 1000 * 1000;
+        std::memcpy(entity.data.data(), &load, sizeof(load));
+        entities.emplace_back(std::move(entity));
+    };
+
+    // sim region handed from the mesh thread to the particle sim
+    struct Region {
+        Particles::Point origin;
+        float radius;
     };
+    std::mutex region_mutex;
+    Region region{sim_config.simulation_origin, sim_config.simulation_radius};
 
     // particle sim update timer
     http_server.addTimer(sim_interval, [&](int) {
+        TRACE_SCOPE("sim_tick");
+        {
+            std::lock_guard<std::mutex> lock(region_mutex);
+            particles.getConfig().simulation_origin = region.origin;
+            particles.getConfig().simulation_radius = region.radius;
+        }
+        auto tick_start = std::chrono::steady_clock::now();
         parse_particles();
         particles.update();
+        // tick cost as a fraction of the sim interval
+        std::chrono::duration<float, std::milli> tick_duration =
+                std::chrono::steady_clock::now() - tick_start;
+        load_balancer.recordTickCost(tick_duration.count() / sim_interval);
         generate_entities();
         mesh_node.offsetRelativeExpiry(entities);
         mesh_node.updateEntities(entities);
@@ -230,17 +432,63 @@ int main(int argc, char* argv[]) {
         return zmq::message_t(response.c_str(), response.size());
     });
 
+    // start trace capture
+    http_server.addRequestHandler("/tracestart", [](zmq::message_t) {
+        Tracer::start();
+        static constexpr char response_data[] = "HTTP/1.1 204 No Content\r\n";
+        return zmq::message_t(
+                const_cast<char*>(response_data), sizeof(response_data), nullptr, nullptr);
+    });
+
+    // stop trace capture and download as chrome trace json
+    http_server.addRequestHandler("/tracestop", [](zmq::message_t) {
+        Tracer::stop();
+        std::stringstream json_stream;
+        Tracer::writeJson(json_stream);
+        auto response = JSON_RESPONSE_HEADER + compress(json_stream).str();
+        return zmq::message_t(response.c_str(), response.size());
+    });
+
+    // end startup trace capture after trace duration
+    if (args.count("trace-file")) {
+        auto trace_file = args["trace-file"].as<std::string>();
+        // one shot, timer removes itself as its last action
+        http_server.addTimer(args["trace-duration"].as<uint32_t>(),
+                [&http_server, trace_file](int timer_id) {
+                    writeTrace(trace_file);
+                    http_server.removeTimer(timer_id);
+                });
+    }
+
     // generate network display
-    http_server.addRequestHandler("/network", [&mesh_node, &display, &sim_config](zmq::message_t) {
+    http_server.addRequestHandler("/network", [&mesh_node, &display, &particles](zmq::message_t) {
         std::stringstream svg_stream;
-        display.drawNetworkSvg(svg_stream, mesh_node, sim_config.simulation_radius);
+        display.drawNetworkSvg(svg_stream, mesh_node, particles.getConfig().simulation_radius);
         auto response = SVG_RESPONSE_HEADER + compress(svg_stream).str();
         return zmq::message_t(response.c_str(), response.size());
     });
 
-    // sim origin migration timer
+    // sim origin migration timer runs on the mesh thread alongside all peer tracker writes
+    float mesh_radius = sim_config.simulation_radius;
     mesh_node.getTransport().addTimer(mesh_interval, [&](int) {
+        TRACE_SCOPE("origin_migration");
         auto& self = mesh_node.getPeerTracker().getNodeInfo();
+        // resize region so hot nodes shrink and cold nodes grow
+        std::vector<std::string> peer_addresses;
+        for (const auto& connected_peer : mesh_node.getConnectedPeers()) {
+            auto peer = mesh_node.getPeerTracker().getPeers().find(connected_peer);
+            if (peer != mesh_node.getPeerTracker().getPeers().end()) {
+                peer_addresses.emplace_back(peer->second.node_info.address);
+            }
+        }
+        float radius = mesh_radius;
+        auto status = load_balancer.balanceRadius(radius, peer_addresses);
+        bool radius_changed = std::abs(radius - mesh_radius) > 0.01f * mesh_radius;
+        mesh_config.logger->log(radius_changed ? vsm::Logger::INFO : vsm::Logger::DEBUG,
+                vsm::Error("Simulation radius adjusted.", LoadBalancer::RADIUS_ADJUSTED), &status,
+                sizeof(status));
+        mesh_radius = radius;
+        // space nodes apart by the sum of both region sizes
         for (const auto& connected_peer : mesh_node.getConnectedPeers()) {
             auto peer = mesh_node.getPeerTracker().getPeers().find(connected_peer);
             if (peer == mesh_node.getPeerTracker().getPeers().end()) {
@@ -249,27 +497,36 @@ int main(int argc, char* argv[]) {
             if (peer->second.node_info.coordinates.size() != 2) {
                 continue;
             }
+            LoadBalancer::Load peer_load;
+            peer_load.radius = radius;
+            load_balancer.getPeerLoad(peer->second.node_info.address, peer_load);
+            float spacing = (radius + peer_load.radius) * M_SQRT1_2;
             float dx = peer->second.node_info.coordinates[0] - self.coordinates[0];
             float dy = peer->second.node_info.coordinates[1] - self.coordinates[1];
             float d2 = dx * dx + dy * dy;
-            float d2_error = 2 * (sim_config.simulation_radius * sim_config.simulation_radius) - d2;
+            float d2_error = spacing * spacing - d2;
             float norm_factor = 1.0f / std::sqrt(d2);
             self.coordinates[0] -= distance_gain * d2_error * dx * norm_factor;
             self.coordinates[1] -= distance_gain * d2_error * dy * norm_factor;
         }
-        particles.getConfig().simulation_origin.x(self.coordinates[0]);
-        particles.getConfig().simulation_origin.y(self.coordinates[1]);
+        std::lock_guard<std::mutex> lock(region_mutex);
+        region.origin = {self.coordinates[0], self.coordinates[1]};
+        region.radius = radius;
     });
 
-    // worker thread runs mesh network
+    // worker thread runs mesh network and region migration, vsm::ZmqTransport only exposes a
+    // blocking poll so it cannot share the http server's zmq::poll loop
     std::thread mesh_thread([&mesh_node]() {
+        Tracer::setThreadName("mesh_thread");
         while (1) {
+            TRACE_SCOPE("mesh_poll");
             mesh_node.getTransport().poll(-1);
         }
     });
     mesh_thread.detach();
 
     // main thread runs http server and particle sim
+    Tracer::setThreadName("main");
     while (1) {
         try {
             http_server.poll();
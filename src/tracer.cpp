@@ -0,0 +1,118 @@
+#include <tracer.hpp>
+
+#include <algorithm>
+
+std::atomic<bool> Tracer::_enabled{false};
+std::atomic<int64_t> Tracer::_stop_timestamp{0};
+std::mutex Tracer::_buffers_mutex;
+std::vector<std::unique_ptr<Tracer::Buffer>> Tracer::_buffers;
+const std::chrono::steady_clock::time_point Tracer::_epoch = std::chrono::steady_clock::now();
+
+int64_t Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _epoch)
+            .count();
+}
+
+Tracer::Buffer& Tracer::getThreadBuffer() {
+    // buffers are registered once per thread and live until exit
+    thread_local Buffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        _buffers.emplace_back(new Buffer());
+        buffer = _buffers.back().get();
+        buffer->thread_id = _buffers.size();
+        buffer->thread_name = "thread_" + std::to_string(buffer->thread_id);
+    }
+    return *buffer;
+}
+
+void Tracer::setThreadName(const char* name) {
+    auto& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(_buffers_mutex);
+    buffer.thread_name = name;
+}
+
+void Tracer::start() {
+    std::lock_guard<std::mutex> lock(_buffers_mutex);
+    // discard events from previous captures
+    for (auto& buffer : _buffers) {
+        buffer->tail = buffer->head.load(std::memory_order_acquire);
+    }
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    if (_enabled.exchange(false, std::memory_order_relaxed)) {
+        _stop_timestamp.store(now(), std::memory_order_relaxed);
+    }
+}
+
+void Tracer::record(const char* name, char phase) {
+    auto timestamp = now();
+    auto& buffer = getThreadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    // claim the slot before writing it, pairs with the acquire fence in writeJson
+    buffer.claimed.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    buffer.events[head % BUFFER_SIZE] = {name, timestamp, phase};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::writeJson(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(_buffers_mutex);
+    int64_t end_timestamp = isEnabled() ? now() : _stop_timestamp.load(std::memory_order_relaxed);
+    std::vector<Event> events;
+    std::vector<const char*> open_scopes;
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : _buffers) {
+        os << (first ? "" : ",") << "\r\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,";
+        os << "\"tid\":" << buffer->thread_id << ",";
+        os << "\"args\":{\"name\":\"" << buffer->thread_name << "\"}}";
+        first = false;
+        // copy events up to a head snapshot, oldest slots may be overwritten while copying
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t tail = buffer->tail;
+        if (head - tail > BUFFER_SIZE - BUFFER_GUARD) {
+            tail = head - (BUFFER_SIZE - BUFFER_GUARD);
+        }
+        events.assign(buffer->events.begin(), buffer->events.end());
+        // drop copied slots that writers claimed before the copy finished, the fence orders the
+        // copy before the claim load so any slot write seen by the copy is also seen as claimed
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t claimed = buffer->claimed.load(std::memory_order_relaxed);
+        if (claimed > tail + BUFFER_SIZE) {
+            tail = std::min(head, claimed - BUFFER_SIZE);
+        }
+        open_scopes.clear();
+        for (uint64_t i = tail; i < head; ++i) {
+            const auto& event = events[i % BUFFER_SIZE];
+            // keep begin/end events balanced within the capture window
+            if (event.timestamp > end_timestamp) {
+                continue;
+            }
+            if (event.phase == 'B') {
+                open_scopes.push_back(event.name);
+            } else if (event.phase == 'E') {
+                if (open_scopes.empty()) {
+                    continue;
+                }
+                open_scopes.pop_back();
+            }
+            os << ",\r\n{\"name\":\"" << event.name << "\",";
+            os << "\"ph\":\"" << event.phase << "\",";
+            os << "\"ts\":" << event.timestamp << ",";
+            os << "\"pid\":1,\"tid\":" << buffer->thread_id << "}";
+        }
+        // close scopes still open when the capture stopped
+        while (!open_scopes.empty()) {
+            os << ",\r\n{\"name\":\"" << open_scopes.back() << "\",";
+            os << "\"ph\":\"E\",";
+            os << "\"ts\":" << end_timestamp << ",";
+            os << "\"pid\":1,\"tid\":" << buffer->thread_id << "}";
+            open_scopes.pop_back();
+        }
+    }
+    os << "\r\n]}\r\n";
+}
@@ -1,4 +1,5 @@
 #include <zmq_http_server.hpp>
+#include <tracer.hpp>
 
 static constexpr char HTTP_404[] =
         "HTTP/1.1 404 Not Found\r\n"
@@ -7,23 +8,33 @@ static constexpr char HTTP_404[] =
         "404 Page Not Found";
 
 void ZmqHttpServer::poll(int timeout) {
-    _timers.execute();
+    {
+        TRACE_SCOPE("ZmqHttpServer::timers");
+        _timers.execute();
+    }
+
+    // wait until next timer deadline or socket becomes readable
+    timeout = std::min<uint32_t>(timeout, _timers.timeout());
+    zmq::pollitem_t poll_item{_http_socket.handle(), 0, ZMQ_POLLIN, 0};
+    {
+        TRACE_SCOPE("ZmqHttpServer::wait");
+        zmq::poll(&poll_item, 1, std::chrono::milliseconds(timeout));
+    }
+    if (!(poll_item.revents & ZMQ_POLLIN)) {
+        return;
+    }
 
     // receive request handle
     zmq::recv_result_t recv_result;
     zmq::message_t request_handle;
-    timeout = std::min<uint32_t>(timeout, _timers.timeout());
-    _http_socket.set(zmq::sockopt::rcvtimeo, timeout);
-    recv_result = _http_socket.recv(request_handle);
+    recv_result = _http_socket.recv(request_handle, zmq::recv_flags::dontwait);
     if (!recv_result || *recv_result != 5) {
         return;
     };
 
-    // receive request
+    // receive request, arrives together with its handle as one multipart message
     zmq::message_t request;
-    timeout = std::min<uint32_t>(timeout, _timers.timeout());
-    _http_socket.set(zmq::sockopt::rcvtimeo, timeout);
-    recv_result = _http_socket.recv(request);
+    recv_result = _http_socket.recv(request, zmq::recv_flags::dontwait);
     if (!recv_result || *recv_result <= 0) {
         return;
     }
@@ -38,6 +49,7 @@ void ZmqHttpServer::poll(int timeout) {
     }
 
     // create and send response
+    TRACE_SCOPE(request_handler->first.c_str());
     auto response = request_handler->second(std::move(request));
     sendResponse(request_handle, response);
 }